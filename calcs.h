@@ -2,6 +2,7 @@
 #define CALCS_H
 
 #include <QString>
+#include <QStringList>
 #include <vector>
 #include <memory>
 
@@ -11,7 +12,18 @@ public:
     virtual ~ConverterBase() {}
     virtual QString name() const = 0;
     virtual double toBase(double value) const = 0; 
-    virtual QString fromBase(double baseValue) const = 0;
+    virtual double fromBaseValue(double baseValue) const = 0;
+
+    QString fromBase(double baseValue) const {
+        return formatValue(fromBaseValue(baseValue));
+    }
+
+    static QString formatValue(double value) {
+        QString s = QString::number(value, 'f', 4);
+        s.remove(QRegExp("0+$")); // remove trailing zeros
+        s.remove(QRegExp("\\.$")); // remove trailing dot if needed
+        return s;
+    }
 };
 
 // ===== Length =====
@@ -49,7 +61,7 @@ public:
         return result;
     }
 
-    QString fromBase(double baseValue) const override {
+    double fromBaseValue(double baseValue) const override {
         double result = 0.0;
         switch(unit) {
             case MM:   result = baseValue * 1000.0; break;
@@ -61,10 +73,7 @@ public:
             case YARD: result = baseValue / 0.9144; break;
             case MILE: result = baseValue / 1609.34; break;
         }
-        QString s = QString::number(result, 'f', 4);
-        s.remove(QRegExp("0+$")); // remove trailing zeros
-        s.remove(QRegExp("\\.$")); // remove trailing dot if needed
-        return s;
+        return result;
     }
 
     static std::vector<std::unique_ptr<ConverterBase>> allUnits() {
@@ -109,17 +118,14 @@ public:
         return result;
     }
 
-    QString fromBase(double baseValue) const override {
+    double fromBaseValue(double baseValue) const override {
         double result = 0.0;
         switch(unit) {
             case C: result = baseValue; break;
             case F: result = baseValue * 9.0 / 5.0 + 32.0; break;
             case K: result = baseValue + 273.15; break;
         }
-        QString s = QString::number(result, 'f', 4);
-        s.remove(QRegExp("0+$"));
-        s.remove(QRegExp("\\.$"));
-        return s;
+        return result;
     }
 
     static std::vector<std::unique_ptr<ConverterBase>> allUnits() {
@@ -161,7 +167,7 @@ public:
         return result;
     }
 
-    QString fromBase(double baseValue) const override {
+    double fromBaseValue(double baseValue) const override {
         double result = 0.0;
         switch(unit) {
             case MPH:  result = baseValue / 0.44704; break;
@@ -169,10 +175,7 @@ public:
             case MS:   result = baseValue; break;
             case FTS:  result = baseValue / 0.3048; break;
         }
-        QString s = QString::number(result, 'f', 4);
-        s.remove(QRegExp("0+$"));
-        s.remove(QRegExp("\\.$"));
-        return s;
+        return result;
     }
 
     static std::vector<std::unique_ptr<ConverterBase>> allUnits() {
@@ -219,7 +222,7 @@ public:
         return result;
     }
 
-    QString fromBase(double baseValue) const override {
+    double fromBaseValue(double baseValue) const override {
         double result = 0.0;
         switch(unit) {
             case N:    result = baseValue; break;
@@ -229,10 +232,7 @@ public:
             case LB:   result = baseValue / 4.44822; break;
             case KIP:  result = baseValue / 4448.22; break;
         }
-        QString s = QString::number(result, 'f', 4);
-        s.remove(QRegExp("0+$"));
-        s.remove(QRegExp("\\.$"));
-        return s;
+        return result;
     }
 
     static std::vector<std::unique_ptr<ConverterBase>> allUnits() {
@@ -287,7 +287,7 @@ public:
         return result;
     }
 
-    QString fromBase(double baseValue) const override {
+    double fromBaseValue(double baseValue) const override {
         double result = 0.0;
         switch(unit) {
             case N_M:    result = baseValue; break;
@@ -303,10 +303,7 @@ public:
             case KGF_IN: result = baseValue / 0.8139; break;
             case KGF_FT: result = baseValue / 9.766; break;
         }
-        QString s = QString::number(result, 'f', 4);
-        s.remove(QRegExp("0+$"));
-        s.remove(QRegExp("\\.$"));
-        return s;
+        return result;
     }
 
     static std::vector<std::unique_ptr<ConverterBase>> allUnits() {
@@ -363,7 +360,7 @@ public:
         return result;
     }
 
-    QString fromBase(double baseValue) const override {
+    double fromBaseValue(double baseValue) const override {
         double result = 0.0;
         switch(unit) {
             case PA:  result = baseValue; break;
@@ -374,10 +371,7 @@ public:
             case PSF: result = baseValue / 47.8803; break;
             case KSF: result = baseValue / 47880.3; break;
         }
-        QString s = QString::number(result, 'f', 4);
-        s.remove(QRegExp("0+$"));
-        s.remove(QRegExp("\\.$"));
-        return s;
+        return result;
     }
 
     static std::vector<std::unique_ptr<ConverterBase>> allUnits() {
@@ -427,7 +421,7 @@ public:
         return result;
     }
 
-    QString fromBase(double baseValue) const override {
+    double fromBaseValue(double baseValue) const override {
         double result = 0.0;
         switch(unit) {
             case MM2: result = baseValue * 1e6; break;
@@ -437,10 +431,7 @@ public:
             case IN2: result = baseValue / 0.00064516; break;
             case FT2: result = baseValue / 0.092903; break;
         }
-        QString s = QString::number(result, 'f', 4);
-        s.remove(QRegExp("0+$"));
-        s.remove(QRegExp("\\.$"));
-        return s;
+        return result;
     }
 
     static std::vector<std::unique_ptr<ConverterBase>> allUnits() {
@@ -489,7 +480,7 @@ public:
         return result;
     }
 
-    QString fromBase(double baseValue) const override {
+    double fromBaseValue(double baseValue) const override {
         double result = 0.0;
         switch(unit) {
             case MM3: result = baseValue * 1e9; break;
@@ -499,10 +490,7 @@ public:
             case IN3: result = baseValue / 1.6387e-5; break;
             case FT3: result = baseValue / 0.0283168; break;
         }
-        QString s = QString::number(result, 'f', 4);
-        s.remove(QRegExp("0+$"));
-        s.remove(QRegExp("\\.$"));
-        return s;
+        return result;
     }
 
     static std::vector<std::unique_ptr<ConverterBase>> allUnits() {
@@ -520,4 +508,21 @@ private:
     Unit unit;
 };
 
+// ===== Category Registry =====
+inline QStringList categoryNames() {
+    return {"Length", "Temperature", "Velocity", "Force", "Moment", "Pressure", "Area", "Volume"};
+}
+
+inline std::vector<std::unique_ptr<ConverterBase>> unitsForCategory(const QString &category) {
+    if (category == "Length")      return LengthConverter::allUnits();
+    if (category == "Temperature") return TemperatureConverter::allUnits();
+    if (category == "Velocity")    return VelocityConverter::allUnits();
+    if (category == "Force")       return ForceConverter::allUnits();
+    if (category == "Moment")      return MomentConverter::allUnits();
+    if (category == "Pressure")    return PressureConverter::allUnits();
+    if (category == "Area")        return AreaConverter::allUnits();
+    if (category == "Volume")      return VolumeConverter::allUnits();
+    return {};
+}
+
 #endif // CALCS_H
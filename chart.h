@@ -0,0 +1,218 @@
+#ifndef CHART_H
+#define CHART_H
+
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+#include <QIODevice>
+#include <QThread>
+#include <algorithm>
+#include <deque>
+#include <future>
+#include <vector>
+#include <memory>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+#include "calcs.h"
+
+// ===== Number Formatting =====
+// Same output as ConverterBase::formatValue() (4 decimals, trailing zeros
+// trimmed) but appends straight into a byte buffer, no QString round trip.
+inline void appendNumber(QByteArray &out, double value) {
+    char small[64];
+    std::vector<char> large;
+    char *buf = small;
+    int n = std::snprintf(small, sizeof(small), "%.4f", value);
+    if (n < 0) return;
+    if (n >= static_cast<int>(sizeof(small))) { // |value| >= ~1e58 needs more room
+        large.resize(n + 1);
+        buf = large.data();
+        std::snprintf(buf, large.size(), "%.4f", value);
+    }
+    while (n > 0 && buf[n - 1] == '0') --n;
+    if (n > 0 && buf[n - 1] == '.') --n;
+    out.append(buf, n);
+}
+
+// Data pipelines (--stream, --convert) write the shortest text that reads
+// back as the same double ("99.97402", not "99.974019999999996"), with at
+// most `maxDigits` significant digits. Any double round-trips within 17.
+inline void appendSignificant(QByteArray &out, double value, int maxDigits = 17) {
+    char buf[32];
+    int n = 0;
+    // %g drops trailing zeros, so when 15 digits round-trip the result is
+    // already the shortest; shorter precisions never need trying.
+    for (int digits = std::min(maxDigits, 15); digits <= maxDigits; ++digits) {
+        n = std::snprintf(buf, sizeof(buf), "%.*g", digits, value);
+        if (digits == maxDigits || std::strtod(buf, nullptr) == value) break;
+    }
+    if (n > 0) out.append(buf, n < static_cast<int>(sizeof(buf)) ? n : static_cast<int>(sizeof(buf)) - 1);
+}
+
+// ===== Number Parsing =====
+// True for [+-]digits[.digits][(e|E)[+-]digits]; no hex, inf or nan.
+// Shared by the batch readers so only real readings are converted.
+inline bool isDecimal(const char *p, const char *end) {
+    int digits = 0;
+    if (p < end && (*p == '+' || *p == '-')) ++p;
+    while (p < end && *p >= '0' && *p <= '9') { ++p; ++digits; }
+    if (p < end && *p == '.') {
+        ++p;
+        while (p < end && *p >= '0' && *p <= '9') { ++p; ++digits; }
+    }
+    if (digits == 0) return false;
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        ++p;
+        if (p < end && (*p == '+' || *p == '-')) ++p;
+        int expDigits = 0;
+        while (p < end && *p >= '0' && *p <= '9') { ++p; ++expDigits; }
+        if (expDigits == 0) return false;
+    }
+    return p == end;
+}
+
+// ===== Chart Generator =====
+// Builds a table with one column per unit; every row is the same quantity
+// expressed in each unit, with the input value given in the first column's
+// unit. Rows are formatted in parallel in fixed-size batches and handed to
+// a single writer in order, so memory stays bounded by the batches in flight.
+class ChartGenerator {
+public:
+    enum Format { Csv, Markdown, Html };
+
+    ChartGenerator(std::vector<std::unique_ptr<ConverterBase>> columns, Format format)
+        : columns(std::move(columns)), format(format) {}
+
+    // Values start, start+step, ... up to stop (inclusive, within rounding).
+    bool writeRange(QIODevice &out, double start, double stop, double step) {
+        if (step <= 0.0 || stop < start) return false;
+        qint64 rows = static_cast<qint64>(std::floor((stop - start) / step + 1e-9)) + 1;
+        return write(out, rows, [start, step](qint64 i) { return start + step * static_cast<double>(i); });
+    }
+
+    bool writeValues(QIODevice &out, const std::vector<double> &values) {
+        return write(out, static_cast<qint64>(values.size()), [&values](qint64 i) { return values[i]; });
+    }
+
+    static bool formatFromName(const QString &name, Format &format) {
+        QString f = name.toLower();
+        if (f == "csv")                        format = Csv;
+        else if (f == "md" || f == "markdown") format = Markdown;
+        else if (f == "html" || f == "htm")    format = Html;
+        else return false;
+        return true;
+    }
+
+private:
+    static const qint64 kBatchRows = 16384;
+
+    template <typename ValueAt>
+    bool write(QIODevice &out, qint64 rows, ValueAt valueAt) {
+        if (columns.empty()) return false;
+        if (out.write(header()) < 0) return false;
+
+        // Keep a couple of batches per core in flight; the oldest is written
+        // as soon as it is ready while the rest keep computing.
+        const int window = 2 * std::max(1, QThread::idealThreadCount());
+        std::deque<std::future<QByteArray>> pending;
+        qint64 next = 0;
+        bool ok = true;
+
+        while (ok && (next < rows || !pending.empty())) {
+            while (next < rows && static_cast<int>(pending.size()) < window) {
+                qint64 first = next;
+                qint64 last = std::min(rows, next + kBatchRows);
+                pending.push_back(std::async(std::launch::async, [this, first, last, valueAt]() {
+                    return formatRows(first, last, valueAt);
+                }));
+                next = last;
+            }
+            ok = out.write(pending.front().get()) >= 0;
+            pending.pop_front();
+        }
+        for (auto &f : pending) f.wait(); // let in-flight batches finish before returning
+
+        return ok && out.write(footer()) >= 0;
+    }
+
+    template <typename ValueAt>
+    QByteArray formatRows(qint64 first, qint64 last, ValueAt valueAt) const {
+        const ConverterBase *input = columns.front().get();
+        QByteArray buf;
+        buf.reserve(static_cast<int>((last - first) * columns.size() * 12));
+
+        for (qint64 i = first; i < last; ++i) {
+            double value = valueAt(i);
+            double base = input->toBase(value);
+            buf += rowOpen();
+            for (size_t c = 0; c < columns.size(); ++c) {
+                if (c > 0) buf += cellSeparator();
+                appendNumber(buf, c == 0 ? value : columns[c]->fromBaseValue(base));
+            }
+            buf += rowClose();
+        }
+        return buf;
+    }
+
+    QByteArray header() const {
+        QByteArray h;
+        switch (format) {
+        case Csv:
+            for (size_t c = 0; c < columns.size(); ++c) {
+                if (c > 0) h += ',';
+                QString n = columns[c]->name();
+                h += n.contains(',') ? ("\"" + n + "\"").toUtf8() : n.toUtf8();
+            }
+            h += '\n';
+            break;
+        case Markdown:
+            h += '|';
+            for (const auto &col : columns) h += " " + col->name().toUtf8() + " |";
+            h += "\n|";
+            for (size_t c = 0; c < columns.size(); ++c) h += "---:|";
+            h += '\n';
+            break;
+        case Html:
+            h += "<table>\n<thead><tr>";
+            for (const auto &col : columns) h += "<th>" + col->name().toHtmlEscaped().toUtf8() + "</th>";
+            h += "</tr></thead>\n<tbody>\n";
+            break;
+        }
+        return h;
+    }
+
+    QByteArray footer() const {
+        return format == Html ? QByteArray("</tbody>\n</table>\n") : QByteArray();
+    }
+
+    const char *rowOpen() const {
+        switch (format) {
+        case Markdown: return "| ";
+        case Html:     return "<tr><td>";
+        default:       return "";
+        }
+    }
+
+    const char *cellSeparator() const {
+        switch (format) {
+        case Markdown: return " | ";
+        case Html:     return "</td><td>";
+        default:       return ",";
+        }
+    }
+
+    const char *rowClose() const {
+        switch (format) {
+        case Markdown: return " |\n";
+        case Html:     return "</td></tr>\n";
+        default:       return "\n";
+        }
+    }
+
+    std::vector<std::unique_ptr<ConverterBase>> columns;
+    Format format;
+};
+
+#endif // CHART_H
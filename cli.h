@@ -0,0 +1,372 @@
+#ifndef CLI_H
+#define CLI_H
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+#include <QElapsedTimer>
+#include <QTemporaryFile>
+#include <algorithm>
+#include <clocale>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <memory>
+
+#ifdef Q_OS_WIN
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <io.h>
+#endif
+
+#include "calcs.h"
+#include "chart.h"
+#include "stream.h"
+#include "compress.h"
+
+// ===== Command Line Modes =====
+// The GUI is the default; any of these flags runs a batch job instead.
+inline bool isCommandLineMode(int argc, char *argv[]) {
+    static const char *const modes[] = {"--chart", "--stream", "--convert"};
+    for (int i = 1; i < argc; ++i) {
+        for (const char *mode : modes) {
+            // Matches "--chart" as well as "--chart=Moment".
+            size_t len = std::strlen(mode);
+            if (std::strncmp(argv[i], mode, len) == 0 && (argv[i][len] == '\0' || argv[i][len] == '=')) return true;
+        }
+    }
+    return false;
+}
+
+// Accepts the exact name() ("ksi (kip/in²)") or its leading symbol ("ksi"),
+// case-insensitively.
+inline std::unique_ptr<ConverterBase> takeUnit(std::vector<std::unique_ptr<ConverterBase>> &units,
+                                               const QString &wanted) {
+    for (int pass = 0; pass < 2; ++pass) {
+        for (auto &u : units) {
+            if (!u) continue;
+            QString n = pass == 0 ? u->name() : u->name().section(' ', 0, 0);
+            if (n.compare(wanted.trimmed(), Qt::CaseInsensitive) == 0) return std::move(u);
+        }
+    }
+    return nullptr;
+}
+
+// Resolves a comma-separated unit list; an empty list means every unit.
+inline bool resolveUnits(const QString &category, const QString &list,
+                         std::vector<std::unique_ptr<ConverterBase>> &out, QTextStream &err) {
+    auto units = unitsForCategory(category);
+    if (units.empty()) {
+        err << "Unknown category: " << category << " (expected " << categoryNames().join(", ") << ")\n";
+        return false;
+    }
+    if (list.isEmpty()) {
+        out = std::move(units);
+        return true;
+    }
+    for (const QString &name : list.split(',', Qt::SkipEmptyParts)) {
+        // Fresh instances so a unit may be listed twice.
+        auto pool = unitsForCategory(category);
+        auto u = takeUnit(pool, name);
+        if (!u) {
+            err << "Unknown " << category << " unit: " << name << "\n";
+            return false;
+        }
+        out.push_back(std::move(u));
+    }
+    return true;
+}
+
+inline bool openOutput(QFile &file, const QString &path) {
+    if (path.isEmpty() || path == "-") return file.open(stdout, QIODevice::WriteOnly);
+    return file.open(QIODevice::WriteOnly | QIODevice::Truncate);
+}
+
+inline int runChart(const QCommandLineParser &parser, QTextStream &err) {
+    std::vector<std::unique_ptr<ConverterBase>> columns;
+    if (!resolveUnits(parser.value("chart"), parser.value("units"), columns, err)) return 1;
+
+    QString output = parser.value("output");
+    ChartGenerator::Format format = ChartGenerator::Csv;
+    QString formatName = parser.isSet("format") ? parser.value("format") : QFileInfo(stripCodecSuffix(output)).suffix();
+    if (!ChartGenerator::formatFromName(formatName, format) && parser.isSet("format")) {
+        err << "Unknown format: " << formatName << " (expected csv, md or html)\n";
+        return 1;
+    }
+
+    std::vector<double> values;
+    double start = 0.0, stop = 0.0, step = 0.0;
+    if (parser.isSet("values")) {
+        for (const QString &v : parser.value("values").split(',', Qt::SkipEmptyParts)) {
+            bool ok;
+            values.push_back(v.toDouble(&ok));
+            if (!ok) { err << "Invalid value: " << v << "\n"; return 1; }
+        }
+    } else {
+        QStringList r = parser.value("range").split(':');
+        bool ok1 = false, ok2 = false, ok3 = false;
+        if (r.size() == 3) {
+            start = r[0].toDouble(&ok1);
+            stop = r[1].toDouble(&ok2);
+            step = r[2].toDouble(&ok3);
+        }
+        if (!ok1 || !ok2 || !ok3 || step <= 0.0 || stop < start) {
+            err << "Expected --range start:stop:step with step > 0, or --values v1,v2,...\n";
+            return 1;
+        }
+    }
+
+    auto encoder = makeEncoder(codecForPath(output));
+    if (!encoder) {
+        err << "Compression format of " << output << " is not available in this build\n";
+        return 1;
+    }
+    QFile file(output);
+    if (!openOutput(file, output)) {
+        err << "Cannot write " << output << ": " << file.errorString() << "\n";
+        return 1;
+    }
+    CompressedWriter out(&file, std::move(encoder));
+    out.open(QIODevice::WriteOnly);
+
+    QElapsedTimer timer;
+    timer.start();
+    ChartGenerator chart(std::move(columns), format);
+    bool ok = parser.isSet("values") ? chart.writeValues(out, values)
+                                     : chart.writeRange(out, start, stop, step);
+    out.close();
+    if (!ok || file.error() != QFileDevice::NoError) {
+        err << "Failed to write chart: " << file.errorString() << "\n";
+        return 1;
+    }
+    err << "Chart written in " << timer.elapsed() << " ms\n";
+    return 0;
+}
+
+inline void requestStreamStop(int) {
+    StreamConverter::stopRequested = 1;
+}
+
+inline int runStream(const QCommandLineParser &parser, QTextStream &err) {
+    std::vector<std::unique_ptr<ConverterBase>> units;
+    if (!resolveUnits(parser.value("stream"), parser.value("units"), units, err)) return 1;
+    if (units.size() != 2) {
+        err << "--stream needs --units <from>,<to>\n";
+        return 1;
+    }
+
+    StreamConverter::Options options;
+    bool ok = true;
+    if (parser.isSet("ring"))  options.ringSize = parser.value("ring").toUInt(&ok);
+    if (ok && parser.isSet("batch")) options.batchSize = parser.value("batch").toUInt(&ok);
+    if (ok && parser.isSet("stats")) options.statsIntervalMs = parser.value("stats").toInt(&ok);
+    if (ok && parser.isSet("precision")) options.precision = parser.value("precision").toInt(&ok);
+    if (!ok || options.ringSize == 0 || options.batchSize == 0 || options.precision < 1 || options.precision > 17) {
+        err << "Invalid --ring, --batch, --stats or --precision value\n";
+        return 1;
+    }
+    options.dropOnFull = parser.isSet("drop");
+
+    QString input = parser.value("input");
+    std::FILE *in = input == "-" ? stdin : std::fopen(QFile::encodeName(input).constData(), "rb");
+    if (!in) {
+        err << "Cannot read " << input << "\n";
+        return 1;
+    }
+    QString output = parser.value("output");
+    std::FILE *out = output == "-" ? stdout : std::fopen(QFile::encodeName(output).constData(), "wb");
+    if (!out) {
+        err << "Cannot write " << output << "\n";
+        if (in != stdin) std::fclose(in);
+        return 1;
+    }
+
+    std::signal(SIGINT, requestStreamStop);
+    std::signal(SIGTERM, requestStreamStop);
+
+    StreamConverter stream(std::move(units[0]), std::move(units[1]), options);
+    bool reachedEnd = stream.run(in, out, err);
+    stream.stats().print(err);
+
+    if (!reachedEnd) {
+        // Stopped by a signal; the detached reader may still be blocked on
+        // a device that never closes and still uses `stream`, so leave
+        // without unwinding or running destructors.
+        std::fflush(nullptr);
+        std::_Exit(130);
+    }
+
+    if (in != stdin) std::fclose(in);
+    if (out != stdout) std::fclose(out);
+    return 0;
+}
+
+inline bool openInput(QFile &file, const QString &path) {
+    if (path.isEmpty() || path == "-") return file.open(stdin, QIODevice::ReadOnly);
+    return file.open(QIODevice::ReadOnly);
+}
+
+inline int runConvert(const QCommandLineParser &parser, QTextStream &err) {
+    std::vector<std::unique_ptr<ConverterBase>> units;
+    if (!resolveUnits(parser.value("convert"), parser.value("units"), units, err)) return 1;
+    if (units.size() != 2) {
+        err << "--convert needs --units <from>,<to>\n";
+        return 1;
+    }
+
+    QVector<int> columns;
+    for (const QString &c : parser.value("columns").split(',', Qt::SkipEmptyParts)) {
+        bool ok;
+        int col = c.toInt(&ok);
+        if (!ok || col < 1) {
+            err << "Invalid column: " << c << " (columns start at 1)\n";
+            return 1;
+        }
+        columns << col - 1;
+    }
+    bool ok = true;
+    int maxDigits = parser.isSet("precision") ? parser.value("precision").toInt(&ok) : 17;
+    if (!ok || maxDigits < 1 || maxDigits > 17) {
+        err << "Invalid --precision value (expected 1 to 17)\n";
+        return 1;
+    }
+    FieldConverter converter(std::move(units[0]), std::move(units[1]), columns, maxDigits);
+
+    QString input = parser.value("input");
+    QString output = parser.value("output");
+    ConvertPipeline pipeline(converter, codecForPath(input), codecForPath(output));
+
+    auto runOnce = [&](bool sequential, const QString &target, qint64 &ms) {
+        QFile in(input), out(target);
+        if (!openInput(in, input)) {
+            err << "Cannot read " << input << ": " << in.errorString() << "\n";
+            return false;
+        }
+        if (!openOutput(out, target)) {
+            err << "Cannot write " << target << ": " << out.errorString() << "\n";
+            return false;
+        }
+        QElapsedTimer timer;
+        timer.start();
+        QString error;
+        bool ok = sequential ? pipeline.runSequential(in, out, error) : pipeline.run(in, out, error);
+        out.flush();
+        ms = timer.elapsed();
+        if (!ok) err << "Conversion failed: " << error << "\n";
+        return ok;
+    };
+
+    qint64 pipelineMs = 0;
+    if (parser.isSet("bench")) {
+        if (input == "-" || output == "-") {
+            err << "--bench needs real --input and -o files\n";
+            return 1;
+        }
+        int runs = parser.isSet("bench-runs") ? parser.value("bench-runs").toInt(&ok) : 3;
+        if (!ok || runs < 1) {
+            err << "Invalid --bench-runs value\n";
+            return 1;
+        }
+
+        // Warm the page cache so neither mode pays for the first cold read.
+        QFile warm(input);
+        if (warm.open(QIODevice::ReadOnly))
+            while (!warm.read(1 << 20).isEmpty()) {}
+
+        // The baseline writes next to the real output so both hit the same disk.
+        QTemporaryFile baselineOut(output + ".bench-XXXXXX");
+        if (!baselineOut.open()) {
+            err << "Cannot create " << baselineOut.fileTemplate() << "\n";
+            return 1;
+        }
+        baselineOut.close();
+
+        // Alternate the order each round so cache and CPU state favour neither mode.
+        std::vector<qint64> sequentialTimes, pipelineTimes;
+        for (int r = 0; r < runs; ++r) {
+            qint64 seqMs = 0, pipeMs = 0;
+            bool sequentialFirst = r % 2 == 0;
+            if (sequentialFirst && !runOnce(true, baselineOut.fileName(), seqMs)) return 1;
+            if (!runOnce(false, output, pipeMs)) return 1;
+            if (!sequentialFirst && !runOnce(true, baselineOut.fileName(), seqMs)) return 1;
+            sequentialTimes.push_back(seqMs);
+            pipelineTimes.push_back(pipeMs);
+        }
+
+        auto report = [&](const char *label, std::vector<qint64> &times) {
+            std::sort(times.begin(), times.end());
+            qint64 median = times[times.size() / 2];
+            err << label << "best " << times.front() << " ms, median " << median << " ms\n";
+            return median;
+        };
+        err << runs << " runs each, order alternated\n";
+        qint64 sequentialMedian = report("decompress-then-convert: ", sequentialTimes);
+        qint64 pipelineMedian = report("pipeline:                ", pipelineTimes);
+        if (pipelineMedian > 0)
+            err << "speedup (median):        " << QString::number(double(sequentialMedian) / pipelineMedian, 'f', 2) << "x\n";
+        return 0;
+    }
+
+    if (!runOnce(false, output, pipelineMs)) return 1;
+    err << "Converted in " << pipelineMs << " ms\n";
+    return 0;
+}
+
+// ell.pro builds a GUI-subsystem executable, so on Windows batch mode
+// starts without stdout/stderr. Borrow the console of the shell that ran
+// us; streams the shell already redirected to a file or pipe are kept.
+inline void attachParentConsole() {
+#ifdef Q_OS_WIN
+    if (!AttachConsole(ATTACH_PARENT_PROCESS)) return;
+    if (_fileno(stdin) < 0)  std::freopen("CONIN$", "r", stdin);
+    if (_fileno(stdout) < 0) std::freopen("CONOUT$", "w", stdout);
+    if (_fileno(stderr) < 0) std::freopen("CONOUT$", "w", stderr);
+#endif
+}
+
+inline int runCommandLine(QCoreApplication &app) {
+    attachParentConsole();
+
+    // QCoreApplication applies the user's locale on Unix; keep '.' as the
+    // decimal point for strtod()/snprintf() in the batch writers.
+    std::setlocale(LC_NUMERIC, "C");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Ell – Engineering Unit Converter (batch mode)");
+    parser.addHelpOption();
+    parser.addOptions({
+        {"chart",  "Generate a conversion chart for <category>.", "category"},
+        {"units",  "Comma-separated units; the first is the input unit. Default: all.", "units"},
+        {"range",  "Input values as start:stop:step.", "range"},
+        {"values", "Comma-separated input values (instead of --range).", "values"},
+        {"format", "csv, md or html. Default: from the output extension, else csv.", "format"},
+        {"stream", "Convert a live feed of numbers, one per line, in <category>.", "category"},
+        {"convert", "Convert the numeric fields of a CSV file in <category>.", "category"},
+        {"columns", "1-based columns to convert for --convert. Default: columns whose header names the from unit.", "list"},
+        {"bench",   "With --convert, also time decompress-then-convert and compare."},
+        {"bench-runs", "Rounds per mode for --bench; best and median are reported. Default: 3.", "n"},
+        {"input",  "Input file (--convert, .gz/.zst read directly), FIFO or device (--stream), or - for stdin.", "file", "-"},
+        {"ring",   "Ring buffer size in samples for --stream. Default: 65536.", "n"},
+        {"batch",  "Samples converted per micro-batch for --stream. Default: 256.", "n"},
+        {"drop",   "Drop samples when the ring is full instead of slowing the reader."},
+        {"stats",  "Print stream counters to stderr every <ms> milliseconds.", "ms"},
+        {"precision", "At most <digits> significant digits per value for --stream and --convert. Default: shortest exact form.", "digits"},
+        {{"o", "output"}, "Output file (.gz/.zst are compressed), or - for stdout.", "file", "-"},
+    });
+    parser.process(app);
+
+    QTextStream err(stderr);
+    if (parser.isSet("chart")) return runChart(parser, err);
+    if (parser.isSet("stream")) return runStream(parser, err);
+    if (parser.isSet("convert")) return runConvert(parser, err);
+
+    parser.showHelp(1);
+    return 1;
+}
+
+#endif // CLI_H
@@ -0,0 +1,633 @@
+#ifndef COMPRESS_H
+#define COMPRESS_H
+
+#include <QString>
+#include <QByteArray>
+#include <QIODevice>
+#include <QTemporaryFile>
+#include <QVector>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef ELL_HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef ELL_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+#include "calcs.h"
+#include "chart.h"
+
+// ===== Codecs =====
+// Picked from the file extension: .gz = gzip, .zst = zstd, anything else
+// is plain text. Each codec is only built when its library was found.
+enum class Codec { Plain, Gzip, Zstd };
+
+inline Codec codecForPath(const QString &path) {
+    if (path.endsWith(".gz", Qt::CaseInsensitive))  return Codec::Gzip;
+    if (path.endsWith(".zst", Qt::CaseInsensitive)) return Codec::Zstd;
+    return Codec::Plain;
+}
+
+// "loads.csv.gz" -> "loads.csv"
+inline QString stripCodecSuffix(const QString &path) {
+    switch (codecForPath(path)) {
+    case Codec::Gzip: return path.left(path.size() - 3);
+    case Codec::Zstd: return path.left(path.size() - 4);
+    default:          return path;
+    }
+}
+
+class Decoder {
+public:
+    virtual ~Decoder() {}
+    // Appends the decoded bytes to `out`; false on corrupt input.
+    virtual bool decode(const char *data, size_t size, QByteArray &out) = 0;
+    // False if the input stopped in the middle of a compressed frame.
+    virtual bool complete() const { return true; }
+};
+
+class Encoder {
+public:
+    virtual ~Encoder() {}
+    virtual bool encode(const char *data, size_t size, QByteArray &out) = 0;
+    virtual bool finish(QByteArray &out) = 0;
+};
+
+class PlainDecoder : public Decoder {
+public:
+    bool decode(const char *data, size_t size, QByteArray &out) override {
+        out.append(data, static_cast<int>(size));
+        return true;
+    }
+};
+
+class PlainEncoder : public Encoder {
+public:
+    bool encode(const char *data, size_t size, QByteArray &out) override {
+        out.append(data, static_cast<int>(size));
+        return true;
+    }
+    bool finish(QByteArray &) override { return true; }
+};
+
+#ifdef ELL_HAVE_ZLIB
+class GzipDecoder : public Decoder {
+public:
+    GzipDecoder() : buf(1 << 16) {
+        std::memset(&zs, 0, sizeof(zs));
+        ok = inflateInit2(&zs, 16 + MAX_WBITS) == Z_OK;
+    }
+    ~GzipDecoder() override { inflateEnd(&zs); }
+
+    bool decode(const char *data, size_t size, QByteArray &out) override {
+        if (!ok) return false;
+        zs.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data));
+        zs.avail_in = static_cast<uInt>(size);
+        do {
+            zs.next_out = reinterpret_cast<Bytef *>(buf.data());
+            zs.avail_out = static_cast<uInt>(buf.size());
+            int rc = inflate(&zs, Z_NO_FLUSH);
+            if (rc != Z_OK && rc != Z_STREAM_END && rc != Z_BUF_ERROR) return false;
+            out.append(buf.data(), static_cast<int>(buf.size() - zs.avail_out));
+            // Multi-member files (e.g. from pigz or cat a.gz b.gz) carry on with the next member.
+            if (rc == Z_STREAM_END && inflateReset(&zs) != Z_OK) return false;
+        } while (zs.avail_in > 0 || zs.avail_out == 0);
+        return true;
+    }
+
+    bool complete() const override { return zs.total_in == 0; } // reset after every finished member
+
+private:
+    z_stream zs;
+    bool ok;
+    std::vector<char> buf;
+};
+
+class GzipEncoder : public Encoder {
+public:
+    explicit GzipEncoder(int level = 6) : buf(1 << 16) {
+        std::memset(&zs, 0, sizeof(zs));
+        ok = deflateInit2(&zs, level, Z_DEFLATED, 16 + MAX_WBITS, 8, Z_DEFAULT_STRATEGY) == Z_OK;
+    }
+    ~GzipEncoder() override { deflateEnd(&zs); }
+
+    bool encode(const char *data, size_t size, QByteArray &out) override { return run(data, size, Z_NO_FLUSH, out); }
+    bool finish(QByteArray &out) override { return run(nullptr, 0, Z_FINISH, out); }
+
+private:
+    bool run(const char *data, size_t size, int flush, QByteArray &out) {
+        if (!ok) return false;
+        zs.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data));
+        zs.avail_in = static_cast<uInt>(size);
+        int rc;
+        do {
+            zs.next_out = reinterpret_cast<Bytef *>(buf.data());
+            zs.avail_out = static_cast<uInt>(buf.size());
+            rc = deflate(&zs, flush);
+            if (rc == Z_STREAM_ERROR) return false;
+            out.append(buf.data(), static_cast<int>(buf.size() - zs.avail_out));
+        } while (zs.avail_out == 0 || (flush == Z_FINISH && rc != Z_STREAM_END));
+        return true;
+    }
+
+    z_stream zs;
+    bool ok;
+    std::vector<char> buf;
+};
+#endif // ELL_HAVE_ZLIB
+
+#ifdef ELL_HAVE_ZSTD
+class ZstdDecoder : public Decoder {
+public:
+    ZstdDecoder() : ctx(ZSTD_createDCtx()), buf(ZSTD_DStreamOutSize()) {}
+    ~ZstdDecoder() override { ZSTD_freeDCtx(ctx); }
+
+    bool decode(const char *data, size_t size, QByteArray &out) override {
+        ZSTD_inBuffer in = {data, size, 0};
+        bool full;
+        do {
+            ZSTD_outBuffer o = {buf.data(), buf.size(), 0};
+            size_t rc = ZSTD_decompressStream(ctx, &o, &in);
+            if (ZSTD_isError(rc)) return false;
+            out.append(buf.data(), static_cast<int>(o.pos));
+            full = o.pos == o.size;
+            if (in.pos > 0 || o.pos > 0) pending = rc;
+        } while (in.pos < in.size || full);
+        return true;
+    }
+
+    bool complete() const override { return pending == 0; } // 0 = frame fully decoded
+
+private:
+    ZSTD_DCtx *ctx;
+    std::vector<char> buf;
+    size_t pending = 0;
+};
+
+class ZstdEncoder : public Encoder {
+public:
+    explicit ZstdEncoder(int level = 3) : ctx(ZSTD_createCCtx()), buf(ZSTD_CStreamOutSize()) {
+        ZSTD_CCtx_setParameter(ctx, ZSTD_c_compressionLevel, level);
+    }
+    ~ZstdEncoder() override { ZSTD_freeCCtx(ctx); }
+
+    bool encode(const char *data, size_t size, QByteArray &out) override {
+        ZSTD_inBuffer in = {data, size, 0};
+        while (in.pos < in.size) {
+            ZSTD_outBuffer o = {buf.data(), buf.size(), 0};
+            size_t rc = ZSTD_compressStream2(ctx, &o, &in, ZSTD_e_continue);
+            if (ZSTD_isError(rc)) return false;
+            out.append(buf.data(), static_cast<int>(o.pos));
+        }
+        return true;
+    }
+
+    bool finish(QByteArray &out) override {
+        ZSTD_inBuffer in = {nullptr, 0, 0};
+        size_t rc;
+        do {
+            ZSTD_outBuffer o = {buf.data(), buf.size(), 0};
+            rc = ZSTD_compressStream2(ctx, &o, &in, ZSTD_e_end);
+            if (ZSTD_isError(rc)) return false;
+            out.append(buf.data(), static_cast<int>(o.pos));
+        } while (rc != 0);
+        return true;
+    }
+
+private:
+    ZSTD_CCtx *ctx;
+    std::vector<char> buf;
+};
+#endif // ELL_HAVE_ZSTD
+
+// Returns nullptr when the codec was not compiled in.
+inline std::unique_ptr<Decoder> makeDecoder(Codec codec) {
+    switch (codec) {
+#ifdef ELL_HAVE_ZLIB
+    case Codec::Gzip: return std::make_unique<GzipDecoder>();
+#endif
+#ifdef ELL_HAVE_ZSTD
+    case Codec::Zstd: return std::make_unique<ZstdDecoder>();
+#endif
+    case Codec::Plain: return std::make_unique<PlainDecoder>();
+    default: return nullptr;
+    }
+}
+
+inline std::unique_ptr<Encoder> makeEncoder(Codec codec) {
+    switch (codec) {
+#ifdef ELL_HAVE_ZLIB
+    case Codec::Gzip: return std::make_unique<GzipEncoder>();
+#endif
+#ifdef ELL_HAVE_ZSTD
+    case Codec::Zstd: return std::make_unique<ZstdEncoder>();
+#endif
+    case Codec::Plain: return std::make_unique<PlainEncoder>();
+    default: return nullptr;
+    }
+}
+
+// ===== Compressed Writer =====
+// Write-only device that compresses into another device, so writers such
+// as ChartGenerator can produce .gz/.zst output unchanged.
+class CompressedWriter : public QIODevice {
+public:
+    CompressedWriter(QIODevice *sink, std::unique_ptr<Encoder> encoder)
+        : sink(sink), encoder(std::move(encoder)) {}
+    ~CompressedWriter() override { close(); }
+
+    void close() override {
+        if (!isOpen()) return;
+        buf.clear();
+        if (encoder->finish(buf)) sink->write(buf);
+        QIODevice::close();
+    }
+
+protected:
+    qint64 readData(char *, qint64) override { return -1; }
+
+    qint64 writeData(const char *data, qint64 len) override {
+        buf.clear();
+        if (!encoder->encode(data, static_cast<size_t>(len), buf)) return -1;
+        if (sink->write(buf) != buf.size()) return -1;
+        return len;
+    }
+
+private:
+    QIODevice *sink;
+    std::unique_ptr<Encoder> encoder;
+    QByteArray buf;
+};
+
+// ===== Bounded Queue =====
+// Blocking hand-off between pipeline stages. close() wakes everyone up:
+// consumers drain what is left, producers get false and stop.
+template <typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(size_t capacity) : capacity(capacity) {}
+
+    bool push(T item) {
+        std::unique_lock<std::mutex> lock(mutex);
+        notFull.wait(lock, [this]() { return items.size() < capacity || closed; });
+        if (closed) return false;
+        items.push_back(std::move(item));
+        notEmpty.notify_one();
+        return true;
+    }
+
+    bool pop(T &item) {
+        std::unique_lock<std::mutex> lock(mutex);
+        notEmpty.wait(lock, [this]() { return !items.empty() || closed; });
+        if (items.empty()) return false;
+        item = std::move(items.front());
+        items.pop_front();
+        notFull.notify_one();
+        return true;
+    }
+
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+        notEmpty.notify_all();
+        notFull.notify_all();
+    }
+
+private:
+    size_t capacity;
+    std::deque<T> items;
+    std::mutex mutex;
+    std::condition_variable notEmpty;
+    std::condition_variable notFull;
+    bool closed = false;
+};
+
+// ===== Field Converter =====
+// Converts numeric fields of RFC 4180 CSV in whole-record blocks. Quoted
+// fields, labels and unselected columns pass through untouched; only plain
+// decimal/exponent numbers are converted, and written in their shortest
+// exact form so cells do not grow noise digits. Without explicit columns the
+// first record is the header: only columns whose header names the from
+// unit ("kip-ft", "M (kip-ft)", "M [kip-ft]") are converted, and their
+// header is renamed to the to unit.
+class FieldConverter {
+public:
+    FieldConverter(std::unique_ptr<ConverterBase> from, std::unique_ptr<ConverterBase> to,
+                   QVector<int> columns = {}, int maxDigits = 17) // columns are 0-based
+        : from(std::move(from)), to(std::move(to)), explicitColumns(columns), maxDigits(maxDigits) {
+        reset();
+    }
+
+    // Call before each file; the header is looked for again.
+    void reset() {
+        columns = explicitColumns;
+        headerSeen = !explicitColumns.isEmpty();
+        failure.clear();
+    }
+
+    // Set when the header names no column in the from unit.
+    const QString &error() const { return failure; }
+
+    QByteArray convert(const QByteArray &block) {
+        QByteArray out;
+        out.reserve(block.size() + block.size() / 4);
+
+        const char *p = block.constData();
+        const char *end = p + block.size();
+        int column = 0;
+        while (p < end) {
+            const char *fieldEnd = scanField(p, end);
+            if (!headerSeen)
+                renameHeader(p, fieldEnd, column, out);
+            else if (*p != '"' && columns.contains(column))
+                convertField(p, fieldEnd, out);
+            else
+                out.append(p, static_cast<int>(fieldEnd - p));
+
+            if (fieldEnd < end) {
+                out += *fieldEnd;
+                if (*fieldEnd == '\n') {
+                    column = 0;
+                    if (!headerSeen) finishHeader();
+                } else {
+                    ++column;
+                }
+            }
+            p = fieldEnd + 1;
+        }
+        if (!headerSeen) finishHeader(); // header-only input without a final newline
+        return out;
+    }
+
+private:
+    // End of the field starting at p: the next ',' or '\n' outside quotes.
+    static const char *scanField(const char *p, const char *end) {
+        if (p < end && *p == '"') {
+            ++p;
+            while (p < end) {
+                if (*p++ != '"') continue;
+                if (p < end && *p == '"') { ++p; continue; } // "" is an escaped quote
+                break;
+            }
+        }
+        while (p < end && *p != ',' && *p != '\n') ++p;
+        return p;
+    }
+
+    static const char *trimEnd(const char *begin, const char *end) {
+        while (end > begin && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r')) --end;
+        return end;
+    }
+
+    void convertField(const char *p, const char *fieldEnd, QByteArray &out) const {
+        const char *value = p;
+        while (value < fieldEnd && (*value == ' ' || *value == '\t')) ++value;
+        const char *valueEnd = trimEnd(value, fieldEnd);
+        if (!isDecimal(value, valueEnd)) {
+            out.append(p, static_cast<int>(fieldEnd - p));
+            return;
+        }
+        out.append(p, static_cast<int>(value - p));
+        appendSignificant(out, to->fromBaseValue(from->toBase(std::strtod(value, nullptr))), maxDigits);
+        out.append(valueEnd, static_cast<int>(fieldEnd - valueEnd));
+    }
+
+    void renameHeader(const char *p, const char *fieldEnd, int column, QByteArray &out) {
+        const char *valueEnd = trimEnd(p, fieldEnd);
+        QString cell = QString::fromUtf8(p, static_cast<int>(valueEnd - p));
+        bool quoted = cell.size() >= 2 && cell.startsWith('"') && cell.endsWith('"');
+        if (quoted) cell = cell.mid(1, cell.size() - 2).replace("\"\"", "\"");
+
+        if (!renameUnit(cell, from->name(), to->name()) &&
+            !renameUnit(cell, symbol(*from), symbol(*to))) {
+            out.append(p, static_cast<int>(fieldEnd - p));
+            return;
+        }
+        columns << column;
+        if (quoted || cell.contains(',') || cell.contains('"') || cell.contains('\n'))
+            cell = "\"" + cell.replace("\"", "\"\"") + "\"";
+        out += cell.toUtf8();
+        out.append(valueEnd, static_cast<int>(fieldEnd - valueEnd));
+    }
+
+    void finishHeader() {
+        headerSeen = true;
+        if (columns.isEmpty())
+            failure = QString("No column header names %1; pass --columns to choose columns").arg(symbol(*from));
+    }
+
+    // "kip-ft" -> "kN-m", "M (kip-ft)" -> "M (kN-m)", "M [kip-ft]" -> "M [kN-m]"
+    static bool renameUnit(QString &cell, const QString &unit, const QString &replacement) {
+        QString trimmed = cell.trimmed();
+        if (trimmed.compare(unit, Qt::CaseInsensitive) == 0) {
+            cell = replacement;
+            return true;
+        }
+        for (const char *brackets : {"()", "[]"}) {
+            QLatin1Char open(brackets[0]), close(brackets[1]);
+            QString suffix = open + unit + close;
+            if (trimmed.endsWith(suffix, Qt::CaseInsensitive)) {
+                cell = trimmed.left(trimmed.size() - suffix.size()) + open + replacement + close;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    static QString symbol(const ConverterBase &unit) { return unit.name().section(' ', 0, 0); }
+
+    std::unique_ptr<ConverterBase> from;
+    std::unique_ptr<ConverterBase> to;
+    QVector<int> explicitColumns;
+    QVector<int> columns;
+    int maxDigits; // cap on significant digits; 17 = shortest exact form
+    bool headerSeen = false;
+    QString failure;
+};
+
+// ===== Convert Pipeline =====
+// Three stages on three threads joined by bounded queues:
+//   read + decompress -> parse + convert -> compress + write
+// Blocks are cut on record boundaries (newlines outside quotes) so the
+// converter never sees half a row.
+// runSequential() is the decompress-to-disk-then-convert baseline used by
+// the --bench comparison.
+class ConvertPipeline {
+public:
+    ConvertPipeline(FieldConverter &converter, Codec inCodec, Codec outCodec)
+        : converter(converter), inCodec(inCodec), outCodec(outCodec) {}
+
+    bool run(QIODevice &in, QIODevice &out, QString &error) {
+        auto decoder = makeDecoder(inCodec);
+        auto encoder = makeEncoder(outCodec);
+        if (!decoder || !encoder) { error = "Compression format not available in this build"; return false; }
+
+        converter.reset();
+        BoundedQueue<QByteArray> decoded(kQueueDepth);
+        BoundedQueue<QByteArray> converted(kQueueDepth);
+        QString readError, convertError;
+
+        std::thread reader([&]() {
+            pumpLines(in, *decoder, [&](QByteArray block) { return decoded.push(std::move(block)); }, readError);
+            decoded.close();
+        });
+        std::thread worker([&]() {
+            QByteArray block;
+            while (decoded.pop(block)) {
+                QByteArray c = converter.convert(block);
+                if (!converter.error().isEmpty()) { convertError = converter.error(); break; }
+                if (!converted.push(std::move(c))) break;
+            }
+            converted.close();
+            decoded.close(); // unblocks the reader if we stopped early
+        });
+
+        bool ok = true;
+        QByteArray block, buf;
+        while (converted.pop(block)) {
+            buf.clear();
+            if (!encoder->encode(block.constData(), block.size(), buf) || out.write(buf) != buf.size()) {
+                error = "Write failed: " + out.errorString();
+                ok = false;
+                converted.close();
+                break;
+            }
+        }
+        worker.join();
+        reader.join();
+
+        if (ok && !convertError.isEmpty()) { error = convertError; ok = false; }
+        if (ok && !readError.isEmpty()) { error = readError; ok = false; }
+        if (ok) {
+            buf.clear();
+            if (!encoder->finish(buf) || out.write(buf) != buf.size()) {
+                error = "Write failed: " + out.errorString();
+                ok = false;
+            }
+        }
+        return ok;
+    }
+
+    // Decompress to a temporary file, convert that into a second one, then
+    // compress it to the output, one step after the other on one thread.
+    bool runSequential(QIODevice &in, QIODevice &out, QString &error) {
+        auto decoder = makeDecoder(inCodec);
+        auto encoder = makeEncoder(outCodec);
+        if (!decoder || !encoder) { error = "Compression format not available in this build"; return false; }
+
+        converter.reset();
+        QTemporaryFile plainIn, plainOut;
+        if (!plainIn.open() || !plainOut.open()) { error = "Cannot create temporary files"; return false; }
+
+        if (!pumpLines(in, *decoder, [&](QByteArray block) { return plainIn.write(block) == block.size(); }, error))
+            return false;
+
+        PlainDecoder plain;
+        plainIn.seek(0);
+        if (!pumpLines(plainIn, plain, [&](QByteArray block) {
+                QByteArray c = converter.convert(block);
+                return converter.error().isEmpty() && plainOut.write(c) == c.size();
+            }, error)) {
+            if (!converter.error().isEmpty()) error = converter.error();
+            return false;
+        }
+
+        QByteArray buf;
+        plainOut.seek(0);
+        if (!pumpLines(plainOut, plain, [&](QByteArray block) {
+                buf.clear();
+                return encoder->encode(block.constData(), block.size(), buf) && out.write(buf) == buf.size();
+            }, error))
+            return false;
+
+        buf.clear();
+        if (!encoder->finish(buf) || out.write(buf) != buf.size()) { error = "Write failed: " + out.errorString(); return false; }
+        return true;
+    }
+
+private:
+    static const int kReadSize = 1 << 20;
+    static const int kMaxRecord = 64 << 20; // one record must fit; keeps `pending` far from QByteArray's 2 GB limit
+    static const size_t kQueueDepth = 8;
+
+    // Where the record scanner is, matching FieldConverter::scanField():
+    // only a '"' that starts a field opens a quoted field, so a stray inch
+    // mark in a label such as 12" plate does not hide every later newline.
+    enum ScanState { FieldStart, Unquoted, Quoted, QuoteInQuoted };
+
+    // Reads and decodes `in`, hands record-aligned blocks to `emitBlock`.
+    // Scan state is carried across reads so a quoted field that spans a
+    // newline is never split.
+    // Returns false on a read/decode error or a record over kMaxRecord
+    // (with `error` set), or when `emitBlock` refuses a block (downstream
+    // stopped).
+    static bool pumpLines(QIODevice &in, Decoder &decoder,
+                          const std::function<bool(QByteArray)> &emitBlock, QString &error) {
+        QByteArray raw(kReadSize, Qt::Uninitialized);
+        QByteArray pending;
+        int scanned = 0;              // bytes of `pending` already scanned
+        ScanState state = FieldStart; // scan state after `scanned` bytes
+        for (;;) {
+            qint64 n = in.read(raw.data(), raw.size());
+            if (n < 0) { error = "Read failed: " + in.errorString(); return false; }
+            if (n == 0) break;
+            if (!decoder.decode(raw.constData(), static_cast<size_t>(n), pending)) {
+                error = "Corrupt compressed input";
+                return false;
+            }
+            int cut = 0;
+            const char *d = pending.constData();
+            for (int i = scanned; i < pending.size(); ++i) {
+                char c = d[i];
+                if (state == Quoted) {
+                    if (c == '"') state = QuoteInQuoted;
+                    continue;
+                }
+                if (state == QuoteInQuoted && c == '"') { // "" is an escaped quote
+                    state = Quoted;
+                    continue;
+                }
+                if (c == '\n') {
+                    cut = i + 1;
+                    state = FieldStart;
+                } else if (c == ',') {
+                    state = FieldStart;
+                } else {
+                    state = c == '"' && state == FieldStart ? Quoted : Unquoted;
+                }
+            }
+            scanned = pending.size();
+            if (cut > 0) {
+                QByteArray rest = pending.mid(cut);
+                pending.truncate(cut);
+                if (!emitBlock(std::move(pending))) return false;
+                pending = std::move(rest);
+                scanned = pending.size();
+            }
+            if (pending.size() > kMaxRecord) {
+                error = state == Quoted || state == QuoteInQuoted
+                    ? QString("Unterminated quoted field: no closing quote within %1 MB").arg(kMaxRecord >> 20)
+                    : QString("Record longer than %1 MB").arg(kMaxRecord >> 20);
+                return false;
+            }
+        }
+        if (!decoder.complete()) { error = "Compressed input is truncated"; return false; }
+        return pending.isEmpty() || emitBlock(std::move(pending));
+    }
+
+    FieldConverter &converter;
+    Codec inCodec;
+    Codec outCodec;
+};
+
+#endif // COMPRESS_H
@@ -10,4 +10,21 @@ TARGET = ell
 
 SOURCES += main.cpp
 
-HEADERS += calcs.h
+HEADERS += calcs.h \
+           search.h \
+           history.h \
+           chart.h \
+           stream.h \
+           compress.h \
+           cli.h
+
+# Optional codecs for .gz/.zst files in the command line modes
+CONFIG += link_pkgconfig
+packagesExist(zlib) {
+    PKGCONFIG += zlib
+    DEFINES += ELL_HAVE_ZLIB
+}
+packagesExist(libzstd) {
+    PKGCONFIG += libzstd
+    DEFINES += ELL_HAVE_ZSTD
+}
@@ -0,0 +1,193 @@
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include <QString>
+#include <QFile>
+#include <QLockFile>
+#include <QDir>
+#include <QStandardPaths>
+#include <QDateTime>
+#include <atomic>
+#include <vector>
+#include <cstddef>
+#include <cstring>
+#include <cstdint>
+
+// ===== History Record =====
+// Fixed 64-byte slot; unit names are stored as UTF-8 and cut to fit.
+// `seq` is the low 32 bits of the record's sequence number plus one, or 0
+// while a writer is filling the slot.
+struct HistoryRecord {
+    qint64 timestamp; // ms since epoch
+    double input;
+    double output;    // unrounded converted value
+    quint32 seq;
+    quint8 category;  // index into categoryNames()
+    char from[17];
+    char to[18];
+
+    QString fromName() const { return QString::fromUtf8(from, static_cast<int>(strnlen(from, sizeof(from)))); }
+    QString toName() const { return QString::fromUtf8(to, static_cast<int>(strnlen(to, sizeof(to)))); }
+};
+static_assert(sizeof(HistoryRecord) == 64, "HistoryRecord must stay one 64-byte slot");
+
+// ===== History Filter =====
+struct HistoryFilter {
+    QString from;                 // empty = any unit
+    QString to;
+    double minInput = -1e300;
+    double maxInput = 1e300;
+
+    bool matches(const HistoryRecord &r) const {
+        if (r.input < minInput || r.input > maxInput) return false;
+        if (!from.isEmpty() && r.fromName() != from) return false;
+        if (!to.isEmpty() && r.toName() != to) return false;
+        return true;
+    }
+};
+
+// ===== Conversion History =====
+// Append-only log in a fixed-size memory-mapped file. Slots form a ring:
+// once the log is full the oldest record is overwritten, so the file
+// never grows. The file may be shared by several Ell windows, so append()
+// reserves its slot with an atomic fetch-add on the mapped counter and
+// publishes the record by stamping `seq` last; readers skip slots whose
+// stamp is missing or changes while they copy. The OS writes dirty pages
+// back on its own, so the GUI thread never waits on disk. Recall walks
+// backwards from the newest slot and only touches the pages it reads.
+class ConversionHistory {
+public:
+    explicit ConversionHistory(const QString &path, quint32 capacity = 16384) : file(path) {
+        // Checking, resizing and initialising the header is not atomic, so
+        // windows starting together take turns; otherwise a late
+        // initialiser would reset the counter under records already written.
+        QLockFile setupLock(path + ".lock");
+        if (!setupLock.tryLock(5000)) return;
+        if (!file.open(QIODevice::ReadWrite)) return;
+
+        qint64 size = sizeof(Header) + qint64(capacity) * sizeof(HistoryRecord);
+        bool fresh = file.size() < qint64(sizeof(Header));
+        if (!fresh) {
+            HeaderPrefix h;
+            file.read(reinterpret_cast<char *>(&h), sizeof(h));
+            fresh = h.magic != kMagic || h.version != kVersion ||
+                    h.recordSize != sizeof(HistoryRecord) || h.capacity == 0;
+            if (!fresh) size = sizeof(Header) + qint64(h.capacity) * sizeof(HistoryRecord);
+        }
+        if (file.size() != size && !file.resize(size)) return;
+
+        uchar *base = file.map(0, size);
+        if (!base) return;
+        header = reinterpret_cast<Header *>(base);
+        records = reinterpret_cast<HistoryRecord *>(base + sizeof(Header));
+
+        if (fresh) {
+            header->capacity = capacity;
+            header->recordSize = sizeof(HistoryRecord);
+            counter()->store(0);
+            header->version = kVersion;
+            header->magic = kMagic; // last, so a half-initialised header never looks valid
+        }
+    }
+
+    static QString defaultPath() {
+        QString dir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+        QDir().mkpath(dir);
+        return dir + "/history.bin";
+    }
+
+    bool isOpen() const { return header != nullptr; }
+
+    // Number of records currently held (at most the capacity).
+    quint64 count() const {
+        if (!header) return 0;
+        quint64 next = counter()->load(std::memory_order_acquire);
+        return next < header->capacity ? next : header->capacity;
+    }
+
+    void append(int category, const QString &from, const QString &to, double input, double output) {
+        if (!header) return;
+
+        HistoryRecord r;
+        std::memset(&r, 0, sizeof(r));
+        quint64 seq = counter()->fetch_add(1, std::memory_order_acq_rel);
+        r.timestamp = QDateTime::currentMSecsSinceEpoch();
+        r.input = input;
+        r.output = output;
+        r.category = static_cast<quint8>(category);
+        copyName(r.from, sizeof(r.from), from);
+        copyName(r.to, sizeof(r.to), to);
+
+        // Mark the slot busy, fill it, then publish it with its stamp.
+        HistoryRecord &slot = records[seq % header->capacity];
+        stamp(slot)->store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(&slot, &r, offsetof(HistoryRecord, seq));
+        std::memcpy(&slot.category, &r.category, sizeof(r) - offsetof(HistoryRecord, category));
+        stamp(slot)->store(static_cast<quint32>(seq) + 1, std::memory_order_release);
+    }
+
+    std::vector<HistoryRecord> last(int n) const {
+        return find(HistoryFilter(), n);
+    }
+
+    // Newest first; stops after `limit` hits.
+    std::vector<HistoryRecord> find(const HistoryFilter &filter, int limit) const {
+        std::vector<HistoryRecord> out;
+        if (!header) return out;
+        quint64 next = counter()->load(std::memory_order_acquire);
+        quint64 n = next < header->capacity ? next : header->capacity;
+        for (quint64 i = 0; i < n && static_cast<int>(out.size()) < limit; ++i) {
+            quint64 seq = next - 1 - i;
+            HistoryRecord &slot = records[seq % header->capacity];
+            quint32 expected = static_cast<quint32>(seq) + 1;
+            if (stamp(slot)->load(std::memory_order_acquire) != expected) continue; // being written or overwritten
+
+            HistoryRecord r;
+            std::memcpy(&r, &slot, sizeof(r));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (stamp(slot)->load(std::memory_order_relaxed) != expected) continue; // torn copy
+
+            if (filter.matches(r)) out.push_back(r);
+        }
+        return out;
+    }
+
+private:
+    struct HeaderPrefix {
+        quint32 magic;
+        quint32 version;
+        quint32 capacity;
+        quint32 recordSize;
+    };
+
+    struct Header : HeaderPrefix {
+        quint64 next; // total records ever appended; only touched through counter()
+        quint64 reserved[5];
+    };
+    static_assert(sizeof(Header) == 64, "Header keeps records 64-byte aligned");
+    static_assert(std::atomic<quint64>::is_always_lock_free && std::atomic<quint32>::is_always_lock_free,
+                  "history counters are shared between processes and must be lock-free");
+
+    static const quint32 kMagic = 0x484c4c45; // "ELLH"
+    static const quint32 kVersion = 2;
+
+    // The mapped words are shared with other processes; lock-free atomics
+    // of the same size are address-free, so they can be used in place.
+    std::atomic<quint64> *counter() const { return reinterpret_cast<std::atomic<quint64> *>(&header->next); }
+    static std::atomic<quint32> *stamp(HistoryRecord &r) { return reinterpret_cast<std::atomic<quint32> *>(&r.seq); }
+
+    static void copyName(char *dst, size_t cap, const QString &name) {
+        QByteArray utf8 = name.toUtf8();
+        int len = utf8.size() < int(cap) ? utf8.size() : int(cap);
+        // Do not split a multi-byte character when cutting.
+        while (len > 0 && len < utf8.size() && (uchar(utf8[len]) & 0xC0) == 0x80) --len;
+        std::memcpy(dst, utf8.constData(), len);
+    }
+
+    QFile file;
+    Header *header = nullptr;
+    HistoryRecord *records = nullptr;
+};
+
+#endif // HISTORY_H
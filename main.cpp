@@ -10,21 +10,43 @@
 #include <QMessageBox>
 #include <QIcon>
 #include <QDoubleValidator>
+#include <QCompleter>
+#include <QStringListModel>
+#include <QAbstractProxyModel>
+#include <QShortcut>
+#include <QMenu>
+#include <QStyle>
 #include <memory>
 #include <vector>
+#include <cmath>
 
 #include "calcs.h"
+#include "search.h"
+#include "history.h"
+#include "cli.h"
 
 class ConverterApp : public QWidget {
     Q_OBJECT
 
 public:
-    ConverterApp(QWidget *parent = nullptr) : QWidget(parent) {
+    ConverterApp(QWidget *parent = nullptr) : QWidget(parent), history(ConversionHistory::defaultPath()) {
         auto *layout = new QVBoxLayout(this);
 
+        // --- Unit search ---
+        search = new QLineEdit(this);
+        search->setPlaceholderText("Search units... (Ctrl+K)");
+        search->setToolTip("Pick a unit from any category. Picks in the current category set the To unit.");
+        search->setClearButtonEnabled(true);
+        searchModel = new QStringListModel(this);
+        searchCompleter = new QCompleter(searchModel, this);
+        searchCompleter->setCompletionMode(QCompleter::UnfilteredPopupCompletion);
+        searchCompleter->setMaxVisibleItems(8);
+        search->setCompleter(searchCompleter);
+        layout->addWidget(search);
+
         // --- Category dropdown ---
         categoryCombo = new QComboBox(this);
-        categoryCombo->addItems({"Length", "Temperature", "Velocity", "Force", "Moment", "Pressure", "Area", "Volume"});
+        categoryCombo->addItems(categoryNames());
         layout->addWidget(categoryCombo);
 
         // --- Input field ---
@@ -75,6 +97,20 @@ public:
         bottomLayout->setSpacing(0);
         bottomLayout->addStretch();
 
+        auto *historyButton = new QPushButton(this);
+        historyButton->setIcon(style()->standardIcon(QStyle::SP_FileDialogDetailedView));
+        historyButton->setToolTip("History");
+        historyButton->setFixedSize(24,24);
+        historyButton->setIconSize(QSize(16,16));
+        historyButton->setFlat(true);
+        historyMenu = new QMenu(historyButton);
+        // Built once and refilled on every show; clear() only drops their menu actions.
+        pairHistoryMenu = new QMenu(historyMenu);
+        nearHistoryMenu = new QMenu(historyMenu);
+        historyButton->setMenu(historyMenu);
+        historyButton->setStyleSheet("QPushButton::menu-indicator { image: none; }");
+        bottomLayout->addWidget(historyButton);
+
         auto *aboutButton = new QPushButton(this);
         aboutButton->setIcon(QIcon(":/assets/info.png"));
         aboutButton->setToolTip("About");
@@ -95,7 +131,15 @@ public:
         connect(button, &QPushButton::clicked, this, &ConverterApp::doConvert);
         connect(copyButton, &QPushButton::clicked, this, &ConverterApp::copyResult);
         connect(aboutButton, &QPushButton::clicked, this, &ConverterApp::showAbout);
+        connect(historyMenu, &QMenu::aboutToShow, this, &ConverterApp::fillHistoryMenu);
         connect(categoryCombo, &QComboBox::currentTextChanged, this, &ConverterApp::loadConverters);
+        connect(search, &QLineEdit::textEdited, this, &ConverterApp::updateSearch);
+        connect(searchCompleter, QOverload<const QModelIndex &>::of(&QCompleter::activated),
+                this, &ConverterApp::pickSearchResult);
+        connect(new QShortcut(QKeySequence("Ctrl+K"), this), &QShortcut::activated, this, [this]() {
+            search->setFocus();
+            search->selectAll();
+        });
 
         // --- Window setup ---
         setWindowFlags(
@@ -106,7 +150,7 @@ public:
             Qt::WindowCloseButtonHint |
             Qt::WindowStaysOnTopHint
         );
-        setFixedSize(220, 200);
+        setFixedSize(220, 230);
         setWindowTitle("Ell");
         setWindowIcon(QIcon(":/assets/icon.png"));
     }
@@ -127,10 +171,65 @@ private slots:
             toIdx   >= 0 && toIdx   < static_cast<int>(converters.size())) {
 
             double baseValue = converters[fromIdx]->toBase(value);
-            result->setText(converters[toIdx]->fromBase(baseValue));
+            double converted = converters[toIdx]->fromBaseValue(baseValue);
+            result->setText(ConverterBase::formatValue(converted));
+            history.append(categoryCombo->currentIndex(), converters[fromIdx]->name(),
+                           converters[toIdx]->name(), value, converted);
         }
     }
 
+    void fillHistoryMenu() {
+        historyMenu->clear();
+        pairHistoryMenu->clear();
+        nearHistoryMenu->clear();
+        const auto records = history.last(10);
+        if (records.empty()) {
+            historyMenu->addAction("No history yet")->setEnabled(false);
+            return;
+        }
+        addHistoryItems(historyMenu, records);
+
+        // Recall by the current unit pair, and by inputs within ±10% of the current value.
+        HistoryFilter filter;
+        filter.from = fromCombo->currentText();
+        filter.to = toCombo->currentText();
+        pairHistoryMenu->setTitle(QString("%1 → %2").arg(filter.from, filter.to));
+        addHistoryItems(pairHistoryMenu, history.find(filter, 10));
+        historyMenu->addMenu(pairHistoryMenu);
+
+        bool ok;
+        double value = input->text().toDouble(&ok);
+        if (ok) {
+            double margin = std::abs(value) * 0.1;
+            filter.minInput = value - margin;
+            filter.maxInput = value + margin;
+            nearHistoryMenu->setTitle(QString("Near %1 %2").arg(input->text(), filter.from));
+            addHistoryItems(nearHistoryMenu, history.find(filter, 10));
+            historyMenu->addMenu(nearHistoryMenu);
+        }
+    }
+
+    void addHistoryItems(QMenu *menu, const std::vector<HistoryRecord> &records) {
+        if (records.empty()) {
+            menu->addAction("No matches")->setEnabled(false);
+            return;
+        }
+        for (const auto &r : records) {
+            QString text = QString("%1 %2 → %3 %4")
+                .arg(QString::number(r.input, 'g', 10), r.fromName(),
+                     ConverterBase::formatValue(r.output), r.toName());
+            connect(menu->addAction(text), &QAction::triggered, this, [this, r]() { recallHistory(r); });
+        }
+    }
+
+    void recallHistory(const HistoryRecord &r) {
+        categoryCombo->setCurrentIndex(r.category);
+        fromCombo->setCurrentIndex(fromCombo->findText(r.fromName()));
+        toCombo->setCurrentIndex(toCombo->findText(r.toName()));
+        input->setText(QString::number(r.input, 'g', 10));
+        result->setText(ConverterBase::formatValue(r.output));
+    }
+
     void copyResult() {
         QApplication::clipboard()->setText(result->text());
     }
@@ -141,7 +240,9 @@ private slots:
             "<u>Features:</u><br>"
             "- Supports multiple categories<br>"
             "- From → To conversion<br>"
+            "- Quick unit search (Ctrl+K)<br>"
             "- Copy result to clipboard<br>"
+            "- Conversion history<br>"
             "- Always on top<br>"
             "- Written with Qt and C++<br><br>"
 
@@ -171,38 +272,39 @@ private slots:
         toCombo->clear();
         converters.clear();
 
-        if (category == "Length") {
-            auto units = LengthConverter::allUnits();
-            for (auto &u : units) registerConverter(std::move(u));
-        }
-        else if (category == "Temperature") {
-            auto units = TemperatureConverter::allUnits();
-            for (auto &u : units) registerConverter(std::move(u));
-        }
-        else if (category == "Velocity") {
-            auto units = VelocityConverter::allUnits();
-            for (auto &u : units) registerConverter(std::move(u));
-        }
-        else if (category == "Force") {
-            auto units = ForceConverter::allUnits();
-            for (auto &u : units) registerConverter(std::move(u));
-        }
-        else if (category == "Moment") {
-            auto units = MomentConverter::allUnits();
-            for (auto &u : units) registerConverter(std::move(u));
-        }
-        else if (category == "Pressure") {
-            auto units = PressureConverter::allUnits();
-            for (auto &u : units) registerConverter(std::move(u));
-        }
-        else if (category == "Area") {
-            auto units = AreaConverter::allUnits();
-            for (auto &u : units) registerConverter(std::move(u));
+        auto units = unitsForCategory(category);
+        for (auto &u : units) registerConverter(std::move(u));
+    }
+
+    void updateSearch(const QString &text) {
+        searchResults = unitIndex.search(text);
+
+        QStringList items;
+        for (const auto &m : searchResults) {
+            const auto &e = unitIndex.entry(m.entry);
+            items << QString("%1  —  %2").arg(e.name, e.category);
         }
-        else if (category == "Volume") {
-            auto units = VolumeConverter::allUnits();
-            for (auto &u : units) registerConverter(std::move(u));
+        searchModel->setStringList(items);
+
+        if (!items.isEmpty()) searchCompleter->complete();
+    }
+
+    void pickSearchResult(const QModelIndex &index) {
+        auto *proxy = qobject_cast<QAbstractProxyModel *>(searchCompleter->completionModel());
+        int row = proxy ? proxy->mapToSource(index).row() : index.row();
+        if (row < 0 || row >= static_cast<int>(searchResults.size())) return;
+
+        const auto &e = unitIndex.entry(searchResults[row].entry);
+        if (categoryCombo->currentText() == e.category) {
+            toCombo->setCurrentIndex(e.unitIndex);
+        } else {
+            categoryCombo->setCurrentText(e.category);
+            fromCombo->setCurrentIndex(e.unitIndex);
         }
+
+        // The completer writes the picked text back after this slot returns.
+        QMetaObject::invokeMethod(search, "clear", Qt::QueuedConnection);
+        input->setFocus();
     }
 
 private:
@@ -213,16 +315,30 @@ private:
     }
 
     QLineEdit *input;
+    QLineEdit *search;
+    QCompleter *searchCompleter;
+    QStringListModel *searchModel;
     QComboBox *fromCombo;
     QComboBox *toCombo;
     QComboBox *categoryCombo;
     QLabel *result;
+    QMenu *historyMenu;
+    QMenu *pairHistoryMenu;
+    QMenu *nearHistoryMenu;
     std::vector<std::unique_ptr<ConverterBase>> converters;
+    UnitIndex unitIndex;
+    std::vector<UnitIndex::Match> searchResults;
+    ConversionHistory history;
 };
 
 #include "main.moc"
 
 int main(int argc, char *argv[]) {
+    if (isCommandLineMode(argc, argv)) {
+        QCoreApplication app(argc, argv);
+        return runCommandLine(app);
+    }
+
     QApplication app(argc, argv);
     ConverterApp window;
     window.show();
@@ -0,0 +1,234 @@
+#ifndef SEARCH_H
+#define SEARCH_H
+
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <vector>
+#include <algorithm>
+
+#include "calcs.h"
+
+// ===== Unit Search Index =====
+// Built once over every converter name() and alias in all categories.
+// Keys are split into tokens kept in one sorted table, so each query term
+// is a binary search plus a short scan. Trigram postings back a fuzzy
+// fallback for typos and infixes ("ipft" -> kip-ft).
+class UnitIndex {
+public:
+    struct Entry {
+        QString category;
+        QString name;
+        int unitIndex; // position in unitsForCategory(category)
+    };
+
+    struct Match {
+        int entry;
+        int score;
+    };
+
+    UnitIndex() {
+        for (const QString &category : categoryNames()) {
+            auto units = unitsForCategory(category);
+            for (int i = 0; i < static_cast<int>(units.size()); ++i)
+                addUnit(category, units[i]->name(), i);
+        }
+        finalize();
+    }
+
+    const Entry &entry(int id) const { return entries[id]; }
+    int size() const { return static_cast<int>(entries.size()); }
+
+    void addUnit(const QString &category, const QString &name, int unitIndex) {
+        int id = static_cast<int>(entries.size());
+        entries.push_back({category, name, unitIndex});
+        addKey(id, name);
+        for (const QString &alias : aliasesFor(name))
+            addKey(id, alias);
+    }
+
+    // Must be called after the last addUnit() and before search().
+    void finalize() {
+        std::sort(tokens.begin(), tokens.end(), [](const Token &a, const Token &b) {
+            return a.text < b.text || (a.text == b.text && a.entry < b.entry);
+        });
+    }
+
+    std::vector<Match> search(const QString &query, int maxResults = 12) const {
+        std::vector<Match> matches;
+        const QStringList terms = tokenize(query);
+        if (terms.isEmpty()) return matches;
+
+        std::vector<int> score = prefixScores(terms);
+        if (terms.size() > 1) { // "kn m" should also hit the squashed key "knm"
+            std::vector<int> joined = prefixScores({terms.join("")});
+            for (size_t e = 0; e < score.size(); ++e)
+                score[e] = std::max(score[e], joined[e]);
+        }
+
+        int found = static_cast<int>(std::count_if(score.begin(), score.end(), [](int s) { return s > 0; }));
+        if (found < maxResults)
+            addTrigramScores(terms.join(""), score);
+
+        for (int e = 0; e < static_cast<int>(score.size()); ++e)
+            if (score[e] > 0) matches.push_back({e, score[e]});
+
+        auto byRank = [this](const Match &a, const Match &b) {
+            if (a.score != b.score) return a.score > b.score;
+            if (entries[a.entry].name.size() != entries[b.entry].name.size())
+                return entries[a.entry].name.size() < entries[b.entry].name.size();
+            return a.entry < b.entry;
+        };
+        if (static_cast<int>(matches.size()) > maxResults) {
+            std::partial_sort(matches.begin(), matches.begin() + maxResults, matches.end(), byRank);
+            matches.resize(maxResults);
+        } else {
+            std::sort(matches.begin(), matches.end(), byRank);
+        }
+        return matches;
+    }
+
+private:
+    struct Token {
+        QString text;
+        int entry;
+    };
+
+    // Lowercase, fold superscripts and split on anything that is not a letter or digit.
+    static QStringList tokenize(const QString &text) {
+        QString s;
+        s.reserve(text.size());
+        for (QChar c : text) {
+            if (c == QChar(0x00B2))      s += '2'; // ²
+            else if (c == QChar(0x00B3)) s += '3'; // ³
+            else if (c.isLetterOrNumber()) s += c.toLower();
+            else s += ' ';
+        }
+        return s.split(' ', Qt::SkipEmptyParts);
+    }
+
+    static QStringList aliasesFor(const QString &name) {
+        static const QHash<QString, QStringList> table = {
+            // Length
+            {"mm",   {"millimeter", "millimetre"}},
+            {"cm",   {"centimeter", "centimetre"}},
+            {"m",    {"meter", "metre"}},
+            {"km",   {"kilometer", "kilometre"}},
+            {"in",   {"inch", "inches"}},
+            {"ft",   {"feet", "foot"}},
+            {"yard", {"yd", "yards"}},
+            {"mile", {"mi", "miles"}},
+            // Temperature
+            {"°C",   {"celsius", "centigrade", "degc"}},
+            {"°F",   {"fahrenheit", "degf"}},
+            {"K",    {"kelvin"}},
+            // Velocity
+            {"mph",  {"miles per hour"}},
+            {"km/h", {"kph", "kmh", "kilometers per hour", "kilometres per hour"}},
+            {"m/s",  {"mps", "meters per second", "metres per second"}},
+            {"ft/s", {"fps", "feet per second"}},
+            // Force
+            {"N",    {"newton"}},
+            {"kN",   {"kilonewton"}},
+            {"kgf",  {"kilogram force"}},
+            {"tonf", {"ton force", "tonne force"}},
+            {"lb",   {"lbf", "pound", "pound force"}},
+            {"kip",  {"kips", "kilopound"}},
+            // Moment
+            {"N-m",    {"newton meter", "newton metre"}},
+            {"N-mm",   {"newton millimeter", "newton millimetre"}},
+            {"kN-m",   {"kilonewton meter", "kilonewton metre"}},
+            {"kN-mm",  {"kilonewton millimeter", "kilonewton millimetre"}},
+            {"lb-in",  {"in-lb", "pound inch", "inch pound"}},
+            {"lb-ft",  {"ft-lb", "pound foot", "foot pound"}},
+            {"kip-in", {"in-kip", "kip inch", "inch kip"}},
+            {"kip-ft", {"ft-kip", "kip foot", "foot kip"}},
+            {"kgf-m",  {"kilogram force meter", "kilogram force metre"}},
+            {"kgf-mm", {"kilogram force millimeter", "kilogram force millimetre"}},
+            {"kgf-in", {"kilogram force inch"}},
+            {"kgf-ft", {"kilogram force foot"}},
+            // Pressure
+            {"Pa (N/m²)",     {"pascal"}},
+            {"kPa (kN/m²)",   {"kilopascal"}},
+            {"MPa (N/mm²)",   {"megapascal"}},
+            {"psi (lb/in²)",  {"pounds per square inch", "lb/sq in"}},
+            {"ksi (kip/in²)", {"kips per square inch", "kip/sq in"}},
+            {"psf (lb/ft²)",  {"pounds per square foot", "lb/sq ft"}},
+            {"ksf (kip/ft²)", {"kips per square foot", "kip/sq ft"}},
+            // Area
+            {"mm²", {"square millimeter", "square millimetre", "sq mm"}},
+            {"cm²", {"square centimeter", "square centimetre", "sq cm"}},
+            {"m²",  {"square meter", "square metre", "sq m"}},
+            {"km²", {"square kilometer", "square kilometre", "sq km"}},
+            {"in²", {"square inch", "sq in"}},
+            {"ft²", {"square foot", "square feet", "sq ft"}},
+            // Volume
+            {"mm³", {"cubic millimeter", "cubic millimetre", "cu mm"}},
+            {"cm³", {"cubic centimeter", "cubic centimetre", "cc", "cu cm"}},
+            {"m³",  {"cubic meter", "cubic metre", "cu m"}},
+            {"km³", {"cubic kilometer", "cubic kilometre", "cu km"}},
+            {"in³", {"cubic inch", "cu in"}},
+            {"ft³", {"cubic foot", "cubic feet", "cu ft"}},
+        };
+        return table.value(name);
+    }
+
+    void addKey(int id, const QString &key) {
+        const QStringList parts = tokenize(key);
+        for (const QString &p : parts)
+            tokens.push_back({p, id});
+
+        QString squashed = parts.join("");
+        if (parts.size() > 1)
+            tokens.push_back({squashed, id});
+
+        for (int i = 0; i + 3 <= squashed.size(); ++i) {
+            std::vector<int> &posting = trigrams[squashed.mid(i, 3)];
+            if (posting.empty() || posting.back() != id)
+                posting.push_back(id);
+        }
+    }
+
+    // Every term must prefix some token of the entry; exact token hits rank higher.
+    std::vector<int> prefixScores(const QStringList &terms) const {
+        std::vector<int> hits(entries.size(), 0);
+        std::vector<int> score(entries.size(), 0);
+        for (int t = 0; t < terms.size(); ++t) {
+            const QString &term = terms[t];
+            auto it = std::lower_bound(tokens.begin(), tokens.end(), term,
+                                       [](const Token &tok, const QString &s) { return tok.text < s; });
+            for (; it != tokens.end() && it->text.startsWith(term); ++it) {
+                if (hits[it->entry] != t) continue; // missed an earlier term, or already counted
+                hits[it->entry] = t + 1;
+                score[it->entry] += (it->text.size() == term.size()) ? 3 : 1;
+            }
+        }
+        for (size_t e = 0; e < score.size(); ++e)
+            score[e] = (hits[e] == terms.size()) ? kPrefixTier + score[e] : 0;
+        return score;
+    }
+
+    // Fills in entries that share at least half of the query's trigrams.
+    void addTrigramScores(const QString &squashed, std::vector<int> &score) const {
+        int total = squashed.size() - 2;
+        if (total <= 0) return;
+
+        std::vector<int> shared(entries.size(), 0);
+        for (int i = 0; i < total; ++i) {
+            auto it = trigrams.constFind(squashed.mid(i, 3));
+            if (it == trigrams.constEnd()) continue;
+            for (int e : it.value()) ++shared[e];
+        }
+        for (size_t e = 0; e < shared.size(); ++e)
+            if (score[e] == 0 && shared[e] * 2 >= total)
+                score[e] = shared[e];
+    }
+
+    static const int kPrefixTier = 1000;
+
+    std::vector<Entry> entries;
+    std::vector<Token> tokens;
+    QHash<QString, std::vector<int>> trigrams;
+};
+
+#endif // SEARCH_H
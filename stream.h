@@ -0,0 +1,267 @@
+#ifndef STREAM_H
+#define STREAM_H
+
+#include <QByteArray>
+#include <QTextStream>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <memory>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+
+#include "calcs.h"
+#include "chart.h"
+
+// ===== SPSC Ring Buffer =====
+// Lock-free single-producer/single-consumer queue. Capacity is rounded up
+// to a power of two; head and tail live on separate cache lines and the
+// producer caches the consumer's head so a push rarely touches shared state.
+template <typename T>
+class SpscRing {
+public:
+    explicit SpscRing(size_t capacity) : mask(roundUp(capacity) - 1), buffer(mask + 1) {}
+
+    size_t capacity() const { return mask + 1; }
+
+    // Producer only. Returns false when the ring is full.
+    bool tryPush(const T &item) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t - cachedHead > mask) {
+            cachedHead = head.load(std::memory_order_acquire);
+            if (t - cachedHead > mask) return false;
+        }
+        buffer[t & mask] = item;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only. Moves up to `max` items into `out`, returns how many.
+    size_t popBatch(T *out, size_t max) {
+        size_t h = head.load(std::memory_order_relaxed);
+        size_t avail = tail.load(std::memory_order_acquire) - h;
+        size_t n = avail < max ? avail : max;
+        for (size_t i = 0; i < n; ++i)
+            out[i] = buffer[(h + i) & mask];
+        head.store(h + n, std::memory_order_release);
+        return n;
+    }
+
+private:
+    static size_t roundUp(size_t n) {
+        size_t p = 2;
+        while (p < n) p <<= 1;
+        return p;
+    }
+
+    alignas(64) std::atomic<size_t> head{0};
+    alignas(64) std::atomic<size_t> tail{0};
+    alignas(64) size_t cachedHead = 0; // producer-side copy of head
+    size_t mask;
+    std::vector<T> buffer;
+};
+
+// ===== Stream Stats =====
+// Counters are bumped by the reader and converter threads; latency is
+// recorded by the converter thread only, from the moment a line is read
+// until the batch carrying it has been written.
+struct StreamStats {
+    std::atomic<quint64> read{0};
+    std::atomic<quint64> written{0};
+    std::atomic<quint64> rejected{0};     // lines that were not a number
+    std::atomic<quint64> backpressure{0}; // times the reader waited on a full ring
+    std::atomic<quint64> overflow{0};     // samples dropped on a full ring (--drop)
+
+    quint64 latencyCount = 0;
+    double latencySumUs = 0.0;
+    double latencyMaxUs = 0.0;
+    quint64 latencyBuckets[32] = {}; // bucket i: below 2^(i+1) us, above the previous bucket
+
+    void addLatency(double us) {
+        ++latencyCount;
+        latencySumUs += us;
+        if (us > latencyMaxUs) latencyMaxUs = us;
+        int b = 0;
+        while (b < 31 && us >= double(2ull << b)) ++b;
+        ++latencyBuckets[b];
+    }
+
+    // Upper bound of the bucket that holds the given percentile.
+    double latencyPercentileUs(double p) const {
+        quint64 target = static_cast<quint64>(p * latencyCount);
+        quint64 seen = 0;
+        for (int b = 0; b < 32; ++b) {
+            seen += latencyBuckets[b];
+            if (seen > target) return double(2ull << b);
+        }
+        return latencyMaxUs;
+    }
+
+    void print(QTextStream &out) const {
+        out << "read " << read.load() << ", written " << written.load()
+            << ", rejected " << rejected.load()
+            << ", backpressure " << backpressure.load()
+            << ", overflow " << overflow.load();
+        if (latencyCount > 0) {
+            out << ", latency mean " << QString::number(latencySumUs / latencyCount, 'f', 1)
+                << " us, p99 < " << latencyPercentileUs(0.99)
+                << " us, max " << QString::number(latencyMaxUs, 'f', 1) << " us";
+        }
+        out << "\n";
+        out.flush();
+    }
+};
+
+// ===== Stream Converter =====
+// Reader thread: parses one number per line from the input and pushes it
+// into the ring. Converter thread: drains the ring in micro-batches,
+// converts through the calcs.h units and hands each batch to the writer,
+// which flushes so downstream consumers see results immediately.
+class StreamConverter {
+public:
+    struct Options {
+        size_t ringSize = 65536;
+        size_t batchSize = 256;
+        bool dropOnFull = false; // drop new samples instead of waiting when the ring is full
+        int statsIntervalMs = 0; // 0 = only print stats at the end
+        int precision = 17;      // cap on significant digits; 17 = shortest exact form
+    };
+
+    // Async-signal-safe; set from the SIGINT/SIGTERM handler so a feed that
+    // never reaches end of file can still be stopped with its final stats.
+    static inline volatile std::sig_atomic_t stopRequested = 0;
+
+    StreamConverter(std::unique_ptr<ConverterBase> from, std::unique_ptr<ConverterBase> to, const Options &options)
+        : from(std::move(from)), to(std::move(to)), options(options), ring(options.ringSize) {}
+
+    const StreamStats &stats() const { return counters; }
+
+    // Blocks until the input reaches end of file and every sample is written,
+    // or until stopRequested is set. Returns false in the latter case; the
+    // reader may then still be blocked on the device, so it is detached.
+    // It keeps using this object, so after a false return the caller must
+    // end the process (runStream() calls _Exit) without destroying it.
+    bool run(std::FILE *in, std::FILE *out, QTextStream &err) {
+        std::thread reader([this, in]() { readLoop(in); });
+        convertLoop(out, err);
+        if (done.load(std::memory_order_acquire)) {
+            reader.join();
+            return true;
+        }
+        reader.detach();
+        return false;
+    }
+
+private:
+    struct Sample {
+        double value;
+        std::chrono::steady_clock::time_point readAt;
+    };
+
+    void readLoop(std::FILE *in) {
+        char line[256];
+        while (!stopRequested && std::fgets(line, sizeof(line), in)) {
+            size_t len = std::strlen(line);
+            if (len == sizeof(line) - 1 && line[len - 1] != '\n') {
+                // Far longer than any reading: skip to the end of the line
+                // and reject it once rather than parsing each piece.
+                int c;
+                while ((c = std::fgetc(in)) != EOF && c != '\n') {}
+                ++counters.rejected;
+                continue;
+            }
+            // One plain decimal per line, so "nan", "0x1A", "12abc" or a
+            // logger's "1699999999,12.5" are rejected instead of converted.
+            const char *p = line;
+            const char *end = line + len;
+            while (p < end && (*p == ' ' || *p == '\t')) ++p;
+            while (end > p && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r' || end[-1] == '\n')) --end;
+            if (!isDecimal(p, end)) {
+                ++counters.rejected;
+                continue;
+            }
+            double v = std::strtod(p, nullptr);
+            ++counters.read;
+
+            Sample s{v, std::chrono::steady_clock::now()};
+            if (ring.tryPush(s)) continue;
+            if (options.dropOnFull) {
+                ++counters.overflow;
+                continue;
+            }
+            ++counters.backpressure;
+            // Same back-off as an idle converter, so a slow output does not pin a core.
+            for (int spins = 0; !stopRequested && !ring.tryPush(s); ++spins) {
+                if (spins < 64) std::this_thread::yield();
+                else std::this_thread::sleep_for(std::chrono::microseconds(50));
+            }
+        }
+        done.store(true, std::memory_order_release);
+    }
+
+    void convertLoop(std::FILE *out, QTextStream &err) {
+        std::vector<Sample> batch(options.batchSize);
+        QByteArray buf;
+        int idle = 0;
+        size_t drainBudget = ring.capacity(); // samples still written after a stop request
+        auto lastStats = std::chrono::steady_clock::now();
+
+        for (;;) {
+            bool finished = done.load(std::memory_order_acquire);
+            bool stopping = stopRequested;
+            size_t n = ring.popBatch(batch.data(), batch.size());
+            if (n == 0) {
+                if (finished || stopping) break;
+                // A stalled feed is when periodic stats matter most.
+                maybePrintStats(err, lastStats);
+                // Spin briefly to keep latency low, then back off so an idle feed costs no CPU.
+                if (++idle < 64) std::this_thread::yield();
+                else std::this_thread::sleep_for(std::chrono::microseconds(50));
+                continue;
+            }
+            idle = 0;
+
+            buf.clear();
+            for (size_t i = 0; i < n; ++i) {
+                appendSignificant(buf, to->fromBaseValue(from->toBase(batch[i].value)), options.precision);
+                buf += '\n';
+            }
+            std::fwrite(buf.constData(), 1, buf.size(), out);
+            std::fflush(out);
+            counters.written += n;
+
+            auto now = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < n; ++i)
+                counters.addLatency(std::chrono::duration<double, std::micro>(now - batch[i].readAt).count());
+
+            maybePrintStats(err, lastStats);
+
+            if (stopping) {
+                // Write what was queued at the stop, but do not chase a live feed forever.
+                drainBudget = drainBudget > n ? drainBudget - n : 0;
+                if (drainBudget == 0) break;
+            }
+        }
+    }
+
+    void maybePrintStats(QTextStream &err, std::chrono::steady_clock::time_point &lastStats) {
+        if (options.statsIntervalMs <= 0) return;
+        auto now = std::chrono::steady_clock::now();
+        if (now - lastStats < std::chrono::milliseconds(options.statsIntervalMs)) return;
+        counters.print(err);
+        lastStats = now;
+    }
+
+    std::unique_ptr<ConverterBase> from;
+    std::unique_ptr<ConverterBase> to;
+    Options options;
+    SpscRing<Sample> ring;
+    StreamStats counters;
+    std::atomic<bool> done{false};
+};
+
+#endif // STREAM_H